@@ -62,7 +62,15 @@ const char* file_format_error::what() const noexcept
 {
     return s_what.c_str();
 }
+libsdl_runtime_error::libsdl_runtime_error()
+{
+    s_what = std::format("libsdl_error: {}", SDL_GetError());
+}
 const char* libsdl_runtime_error::what() const noexcept
 {
-    return SDL_GetError();
+    return s_what.c_str();
+}
+const char* load_cancelled_error::what() const noexcept
+{
+    return "load_cancelled_error: stop requested while loading";
 }
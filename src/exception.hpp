@@ -54,6 +54,19 @@ namespace libsc3
     };
     class libsdl_runtime_error : public std::exception
     {
+    private:
+        // SDL keeps its error per thread, the exception may be rethrown on
+        // another one.
+        std::string s_what;
+
+    public:
+        virtual const char* what() const noexcept override final;
+
+    public:
+        libsdl_runtime_error();
+    };
+    class load_cancelled_error : public std::exception
+    {
     public:
         virtual const char* what() const noexcept override final;
     };
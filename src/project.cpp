@@ -18,9 +18,12 @@
 
 #include "project.hpp"
 #include "exception.hpp"
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
 #include <limits>
+#include <thread>
+#include <unordered_set>
 using namespace libsc3;
 namespace detail
 {
@@ -52,7 +55,7 @@ libzip_file_read_helper(project::element_file_type file_to_read)
     void*                 buffer      = std::malloc(buffer_size);
     std::memset(buffer, 0, buffer_size);
     auto read_out_size = zip_fread(file_to_read, buffer, buffer_size);
-    if (read_out_size == -1u)
+    if (read_out_size == -1)
     {
         throw libzip_runtime_error(file_to_read);
     }
@@ -64,82 +67,373 @@ libzip_file_read_helper(project::element_file_type file_to_read)
     return { buffer, static_cast<int>(read_out_size) };
 }
 
-project::project(const std::filesystem::path& path)
+/**
+ * @brief helper to open a .sb3 file and all of its compressed files
+ *
+ * @param path an value presenting the .sb3 file
+ * @param elem_list compressed file list to fill
+ * @return the opened bundle
+ */
+static inline project::project_bundle_type libzip_bundle_open_helper(
+    const std::filesystem::path&                                 path,
+    std::unordered_map<std::string, project::element_file_type>& elem_list)
 {
-    int zip_errorno;
-    this->compressed_bundle =
+    int  zip_errorno;
+    auto bundle =
         zip_open(path.c_str(), ZIP_CHECKCONS | ZIP_RDONLY, &zip_errorno);
-    if (this->compressed_bundle == nullptr)
+    if (bundle == nullptr)
     {
         throw libzip_runtime_error(zip_errorno);
     }
 
-    auto element_count = zip_get_num_entries(this->compressed_bundle, 0);
+    auto element_count = zip_get_num_entries(bundle, 0);
     for (decltype(element_count) i = 0; i < element_count; i++)
     {
         zip_stat_t stat_data;
-        auto result = zip_stat_index(this->compressed_bundle, i, 0, &stat_data);
+        auto       result = zip_stat_index(bundle, i, 0, &stat_data);
         if (result != 0)
         {
-            throw libzip_runtime_error(this->compressed_bundle);
+            throw libzip_runtime_error(bundle);
         }
-        this->element_list.insert_or_assign(
-            stat_data.name, zip_fopen_index(this->compressed_bundle, i, 0));
+        elem_list.insert_or_assign(
+            stat_data.name, zip_fopen_index(bundle, i, 0));
     }
+    return bundle;
+}
+
+/**
+ * @brief helper to close a bundle opened by libzip_bundle_open_helper
+ *
+ * @param bundle the bundle to close
+ * @param elem_list compressed file list of the bundle
+ */
+static inline void libzip_bundle_close_helper(
+    project::project_bundle_type                                 bundle,
+    std::unordered_map<std::string, project::element_file_type>& elem_list)
+{
+    for (auto&& i : elem_list)
+    {
+        zip_fclose(i.second);
+    }
+    zip_close(bundle);
+}
+
+namespace detail
+{
+    /**
+     * @brief a bundle and its compressed files, whatever is held is closed on
+     * destruction
+     */
+    class bundle_holder
+    {
+    public:
+        project::project_bundle_type bundle = nullptr;
+        std::unordered_map<std::string, project::element_file_type>
+            element_list;
+
+    public:
+        bundle_holder(const std::filesystem::path& path)
+        {
+            this->bundle = libzip_bundle_open_helper(path, this->element_list);
+        }
+        bundle_holder(const bundle_holder&) = delete;
+        ~bundle_holder()
+        {
+            libzip_bundle_close_helper(this->bundle, this->element_list);
+        }
+    };
+} // namespace detail
 
-    // read entire project.json out.
-    auto file_to_read = this->element_list["project.json"];
-    auto file_buffer  = libzip_file_read_helper(file_to_read);
+/**
+ * @brief helper to read entire project.json out
+ *
+ * @param elem_list compressed file list of the bundle
+ * @return the parsed project.json
+ */
+static inline boost::json::object project_source_read_helper(
+    std::unordered_map<std::string, project::element_file_type>& elem_list)
+{
+    auto file_to_read = elem_list.find("project.json");
+    if (file_to_read == elem_list.end())
+    {
+        boost::json::value missing_name = "project.json";
+        throw file_format_error("missing in bundle", missing_name);
+    }
+    auto file_buffer = libzip_file_read_helper(file_to_read->second);
     // it do make a copy, but pmr is too complex for now.
-    this->project_source =
-        boost::json::parse(static_cast<char*>(file_buffer.first)).as_object();
+    return boost::json::parse(static_cast<char*>(file_buffer.first))
+        .as_object();
+}
 
-    this->stage_target = target_list.end();
-    for (auto&& i : this->project_source["targets"].as_array())
+project::project(const std::filesystem::path& path)
+    : project(path, nullptr)
+{
+}
+project::project(
+    const std::filesystem::path& path, progress_callback_type callback,
+    std::stop_token stop_token)
+{
+    this->compressed_bundle =
+        libzip_bundle_open_helper(path, this->element_list);
+    // the destructor won't run if the constructor throws.
+    try
     {
-        std::string_view target_name_view = i.as_object()["name"].as_string();
-        if (i.as_object()["isStage"].as_bool())
+        this->project_source = project_source_read_helper(this->element_list);
+
+        // the stage is always the first target, sprites that are visible
+        // follow it to make the first frame available as soon as possible.
+        std::vector<boost::json::value*> load_order;
+        for (auto&& i : this->project_source["targets"].as_array())
         {
-            auto result = this->target_list.emplace(
-                std::piecewise_construct,
-                std::forward_as_tuple(target_name_view),
-                std::forward_as_tuple(i, this->element_list));
+            load_order.push_back(&i);
+        }
+        if (!load_order.empty())
+        {
+            std::stable_partition(
+                load_order.begin() + 1, load_order.end(),
+                [](boost::json::value* i) {
+                    auto visible = i->as_object().if_contains("visible");
+                    return visible != nullptr && visible->is_bool() &&
+                           visible->as_bool();
+                });
+        }
 
-            if (this->stage_target == target_list.end())
+        // decode every md5ext once, even if several costumes or sounds
+        // refer to it.
+        asset_pool pool;
+        this->stage_target = target_list.end();
+        for (std::size_t i = 0; i < load_order.size(); i++)
+        {
+            if (stop_token.stop_requested())
             {
-                this->stage_target = result.first;
+                throw load_cancelled_error();
             }
-            else
+            auto&& result = emplace_target(
+                this->target_list, this->stage_target, this->element_list,
+                *load_order[i], nullptr, &pool);
+            if (callback)
             {
-                throw file_format_error("duplicated stage detected", i);
+                callback(result, i + 1, load_order.size());
             }
         }
+    }
+    catch (...)
+    {
+        this->target_list.clear();
+        libzip_bundle_close_helper(this->compressed_bundle, this->element_list);
+        throw;
+    }
+}
+auto project::load_async(
+    const std::filesystem::path& path, progress_callback_type callback,
+    std::stop_token stop_token) -> std::future<std::unique_ptr<project>>
+{
+    std::promise<std::unique_ptr<project>> promise;
+    auto                                   result = promise.get_future();
+    std::thread(
+        [path, callback = std::move(callback),
+         stop_token = std::move(stop_token),
+         promise    = std::move(promise)]() mutable {
+            try
+            {
+                promise.set_value(std::make_unique<project>(
+                    path, std::move(callback), std::move(stop_token)));
+            }
+            catch (...)
+            {
+                promise.set_exception(std::current_exception());
+            }
+        })
+        .detach();
+    return result;
+}
+project::~project()
+{
+    libzip_bundle_close_helper(this->compressed_bundle, this->element_list);
+}
+target& project::emplace_target(
+    decltype(target_list)& list, decltype(stage_target)& list_stage,
+    std::unordered_map<std::string, element_file_type>& elem_list,
+    boost::json::value&                                 json_value,
+    decltype(target_list)::node_type* previous, asset_pool* pool)
+{
+    std::string_view target_name_view =
+        json_value.as_object()["name"].as_string();
+    if (json_value.as_object()["isStage"].as_bool())
+    {
+        if (list_stage != list.end())
+        {
+            throw file_format_error("duplicated stage detected", json_value);
+        }
+        if (previous != nullptr)
+        {
+            list_stage = list.insert(std::move(*previous)).position;
+        }
         else
         {
-            if (this->stage_target != target_list.end())
-            {
-                auto&& stage_ref =
-                    static_cast<stage&>(this->stage_target->second);
-                this->target_list.emplace(
+            list_stage = list.emplace(
+                                 std::piecewise_construct,
+                                 std::forward_as_tuple(target_name_view),
+                                 std::forward_as_tuple(
+                                     json_value, elem_list, pool))
+                             .first;
+        }
+        return list_stage->second;
+    }
+    else
+    {
+        if (list_stage == list.end())
+        {
+            throw file_format_error(
+                "a non stage target listed front of stage", json_value);
+        }
+        if (previous != nullptr)
+        {
+            return list.insert(std::move(*previous)).position->second;
+        }
+        else
+        {
+            auto&& stage_ref = static_cast<stage&>(list_stage->second);
+            return list
+                .emplace(
                     std::piecewise_construct,
                     std::forward_as_tuple(target_name_view),
-                    std::forward_as_tuple(stage_ref, i, this->element_list));
+                    std::forward_as_tuple(
+                        stage_ref, json_value, elem_list, pool))
+                .first->second;
+        }
+    }
+}
+auto project::get_stage() -> stage&
+{
+    if (this->stage_target == target_list.end())
+    {
+        throw std::out_of_range("project has no stage");
+    }
+    return static_cast<stage&>(this->stage_target->second);
+}
+void project::reload(const std::filesystem::path& path)
+{
+    // everything of the new revision is owned by locals until it is complete,
+    // so any exception below leaves this project untouched.
+    detail::bundle_holder reload_bundle(path);
+    auto reload_source = project_source_read_helper(reload_bundle.element_list);
+
+    // index both revisions by target name to find the unchanged ones.
+    std::unordered_map<std::string_view, boost::json::value*> previous_json;
+    for (auto&& i : this->project_source["targets"].as_array())
+    {
+        previous_json.emplace(i.as_object()["name"].as_string(), &i);
+    }
+    std::unordered_map<std::string_view, boost::json::value*> reload_json;
+    for (auto&& i : reload_source["targets"].as_array())
+    {
+        reload_json.emplace(i.as_object()["name"].as_string(), &i);
+    }
+    auto is_unchanged = [&](std::string_view name) {
+        auto previous_it = previous_json.find(name);
+        auto reload_it   = reload_json.find(name);
+        return previous_it != previous_json.end() &&
+               reload_it != reload_json.end() &&
+               *previous_it->second == *reload_it->second;
+    };
+
+    // sprites hold a reference to the stage, they can only be kept along
+    // with it.
+    std::unordered_set<std::string> kept_list;
+    if (this->stage_target != target_list.end() &&
+        is_unchanged(this->stage_target->first))
+    {
+        for (auto&& i : this->target_list)
+        {
+            if (is_unchanged(i.first))
+            {
+                kept_list.insert(i.first);
+            }
+        }
+    }
+
+    // targets to reconstruct share media through the pool, so only those
+    // with a new md5ext are decoded again.
+    asset_pool pool;
+    for (auto&& i : this->target_list)
+    {
+        i.second.share_assets(pool);
+    }
+
+    bool        has_stage = this->stage_target != target_list.end();
+    std::string previous_stage_name;
+    if (has_stage)
+    {
+        previous_stage_name = this->stage_target->first;
+    }
+    decltype(target_list) reload_list;
+    auto                  reload_stage = reload_list.end();
+    // kept targets stay owned here until inserted, so that none is lost when
+    // emplace_target throws.
+    std::vector<decltype(target_list)::node_type> extracted_list;
+    try
+    {
+        for (auto&& i : reload_source["targets"].as_array())
+        {
+            std::string target_name(i.as_object()["name"].as_string());
+            auto        previous = this->target_list.find(target_name);
+            if (previous == this->target_list.end())
+            {
+                emplace_target(
+                    reload_list, reload_stage, reload_bundle.element_list, i,
+                    nullptr, &pool);
+            }
+            else if (kept_list.contains(target_name))
+            {
+                extracted_list.push_back(this->target_list.extract(previous));
+                emplace_target(
+                    reload_list, reload_stage, reload_bundle.element_list, i,
+                    &extracted_list.back(), &pool);
             }
             else
             {
-                throw file_format_error(
-                    "a non stage target listed front of stage", i);
+                emplace_target(
+                    reload_list, reload_stage, reload_bundle.element_list, i,
+                    nullptr, &pool)
+                    .inherit_variables(
+                        previous->second, *previous_json.at(target_name), i);
             }
         }
     }
-}
-project::~project()
-{
-    for (auto&& i : this->element_list)
+    catch (...)
     {
-        zip_fclose(i.second);
+        // hand the kept targets back, extracting and inserting nodes keeps
+        // their addresses.
+        for (auto&& i : kept_list)
+        {
+            auto node = reload_list.extract(i);
+            if (!node.empty())
+            {
+                this->target_list.insert(std::move(node));
+            }
+        }
+        for (auto&& i : extracted_list)
+        {
+            if (!i.empty())
+            {
+                this->target_list.insert(std::move(i));
+            }
+        }
+        if (has_stage)
+        {
+            this->stage_target = this->target_list.find(previous_stage_name);
+        }
+        throw;
     }
-    zip_close(this->compressed_bundle);
+
+    // commit, the previous revision is released along with the locals.
+    bool reload_has_stage = reload_stage != reload_list.end();
+    std::swap(this->compressed_bundle, reload_bundle.bundle);
+    std::swap(this->element_list, reload_bundle.element_list);
+    std::swap(this->project_source, reload_source);
+    std::swap(this->target_list, reload_list);
+    this->stage_target = reload_has_stage ? reload_stage : target_list.end();
 }
 static inline target::variable_value_type
 variable_value_helper(boost::json::value& va)
@@ -164,11 +458,13 @@ variable_value_helper(boost::json::value& va)
 }
 target::target(
     boost::json::value&                                 json_value,
-    std::unordered_map<std::string, element_file_type>& elem_list)
-    : target(static_cast<stage&>(*this), json_value, elem_list){};
+    std::unordered_map<std::string, element_file_type>& elem_list,
+    asset_pool*                                         pool)
+    : target(static_cast<stage&>(*this), json_value, elem_list, pool){};
 target::target(
     stage& stage, boost::json::value& json_value,
-    std::unordered_map<std::string, element_file_type>& elem_list)
+    std::unordered_map<std::string, element_file_type>& elem_list,
+    asset_pool*                                         pool)
     : stage_reference(stage)
 {
     this->name = json_value.as_object()["name"].as_string();
@@ -246,30 +542,56 @@ target::target(
     for (auto&& i : json_value.as_object()["costumes"].as_array())
     {
         auto costume_name = std::string(i.as_object()["name"].as_string());
-        auto file_to_read =
-            elem_list[std::string(i.as_object()["md5ext"].as_string())];
-        auto file_buffer = libzip_file_read_helper(file_to_read);
+        auto costume_md5ext =
+            std::string(i.as_object()["md5ext"].as_string());
 
-        auto costume_rw = SDL_RWFromMem(file_buffer.first, file_buffer.second);
-        if (costume_rw == nullptr)
+        renderer_surface_type costume_surface;
+        if (pool != nullptr)
         {
-            throw libsdl_runtime_error();
+            auto pooled = pool->costume_list.find(costume_md5ext);
+            if (pooled != pool->costume_list.end())
+            {
+                costume_surface = pooled->second;
+            }
         }
-
-        auto data_fmt_str =
-            std::string(i.as_object()["dataFormat"].as_string());
-        std::transform(
-            data_fmt_str.begin(), data_fmt_str.end(), data_fmt_str.begin(),
-            ::toupper);
-        // number "1" in arguments presenting to free RWpos when returning. so
-        // no need for SDL_RWclose below
-        auto costume_surface =
-            IMG_LoadTyped_RW(costume_rw, 1, data_fmt_str.c_str());
         if (costume_surface == nullptr)
         {
-            throw libsdl_runtime_error();
+            auto file_to_read = elem_list.find(costume_md5ext);
+            if (file_to_read == elem_list.end())
+            {
+                throw file_format_error("a costume missing in bundle", i);
+            }
+            auto file_buffer = libzip_file_read_helper(file_to_read->second);
+
+            auto costume_rw =
+                SDL_RWFromMem(file_buffer.first, file_buffer.second);
+            if (costume_rw == nullptr)
+            {
+                throw libsdl_runtime_error();
+            }
+
+            auto data_fmt_str =
+                std::string(i.as_object()["dataFormat"].as_string());
+            std::transform(
+                data_fmt_str.begin(), data_fmt_str.end(), data_fmt_str.begin(),
+                ::toupper);
+            // number "1" in arguments presenting to free RWpos when returning.
+            // so no need for SDL_RWclose below
+            auto loaded_surface =
+                IMG_LoadTyped_RW(costume_rw, 1, data_fmt_str.c_str());
+            if (loaded_surface == nullptr)
+            {
+                throw libsdl_runtime_error();
+            }
+            costume_surface.reset(loaded_surface, SDL_FreeSurface);
+            // each compressed file can be read only once.
+            if (pool != nullptr)
+            {
+                pool->costume_list.try_emplace(costume_md5ext, costume_surface);
+            }
         }
-        costume_list.insert_or_assign(costume_name, costume_surface);
+        costume_list.insert_or_assign(
+            costume_name, std::make_pair(costume_md5ext, costume_surface));
     }
 
     // FORMAT EXAMPLE:
@@ -289,34 +611,104 @@ target::target(
 
     for (auto&& i : json_value.as_object()["sounds"].as_array())
     {
-        auto sound_name = std::string(i.as_object()["name"].as_string());
-        auto file_to_read =
-            elem_list[std::string(i.as_object()["md5ext"].as_string())];
-        auto file_buffer = libzip_file_read_helper(file_to_read);
-        auto sound_rw    = SDL_RWFromMem(file_buffer.first, file_buffer.second);
-        if (sound_rw == nullptr)
+        auto sound_name   = std::string(i.as_object()["name"].as_string());
+        auto sound_md5ext = std::string(i.as_object()["md5ext"].as_string());
+
+        mixer_sound_type sound_target;
+        if (pool != nullptr)
         {
-            throw libsdl_runtime_error();
+            auto pooled = pool->sound_list.find(sound_md5ext);
+            if (pooled != pool->sound_list.end())
+            {
+                sound_target = pooled->second;
+            }
         }
-        // number "1" in arguments presenting to free RWpos when returning. so
-        // no need for SDL_RWclose below
-        auto sound_target = Mix_LoadWAV_RW(sound_rw, 1);
         if (sound_target == nullptr)
         {
-            throw libsdl_runtime_error();
+            auto file_to_read = elem_list.find(sound_md5ext);
+            if (file_to_read == elem_list.end())
+            {
+                throw file_format_error("a sound missing in bundle", i);
+            }
+            auto file_buffer = libzip_file_read_helper(file_to_read->second);
+            auto sound_rw =
+                SDL_RWFromMem(file_buffer.first, file_buffer.second);
+            if (sound_rw == nullptr)
+            {
+                throw libsdl_runtime_error();
+            }
+            // number "1" in arguments presenting to free RWpos when returning.
+            // so no need for SDL_RWclose below
+            auto loaded_sound = Mix_LoadWAV_RW(sound_rw, 1);
+            if (loaded_sound == nullptr)
+            {
+                throw libsdl_runtime_error();
+            }
+            sound_target.reset(loaded_sound, Mix_FreeChunk);
+            // each compressed file can be read only once.
+            if (pool != nullptr)
+            {
+                pool->sound_list.try_emplace(sound_md5ext, sound_target);
+            }
         }
-        sound_list.insert_or_assign(sound_name, sound_target);
+        sound_list.insert_or_assign(
+            sound_name, std::make_pair(sound_md5ext, sound_target));
     }
 }
-target::~target()
+auto target::get_name() const -> const std::string&
+{
+    return name;
+}
+auto target::get_costume_list() const -> const decltype(costume_list)&
+{
+    return costume_list;
+}
+auto target::get_sound_list() const -> const decltype(sound_list)&
+{
+    return sound_list;
+}
+void target::share_assets(asset_pool& pool) const
 {
     for (auto&& i : sound_list)
     {
-        Mix_FreeChunk(i.second);
+        pool.sound_list.try_emplace(i.second.first, i.second.second);
     }
     for (auto&& i : costume_list)
     {
-        SDL_FreeSurface(i.second);
+        pool.costume_list.try_emplace(i.second.first, i.second.second);
+    }
+}
+void target::inherit_variables(
+    const target& previous, const boost::json::value& previous_json,
+    const boost::json::value& json_value)
+{
+    // the saved entry, name with initial value, edited in the editor wins
+    // over the runtime value.
+    auto is_unchanged = [&](const char* kind, const std::string& id) {
+        auto previous_entry =
+            previous_json.as_object().at(kind).as_object().if_contains(id);
+        auto entry =
+            json_value.as_object().at(kind).as_object().if_contains(id);
+        return previous_entry != nullptr && entry != nullptr &&
+               *previous_entry == *entry;
+    };
+    for (auto&& i : variable_list)
+    {
+        auto previous_it = previous.variable_list.find(i.first);
+        if (previous_it != previous.variable_list.end() &&
+            is_unchanged("variables", i.first))
+        {
+            i.second.second = previous_it->second.second;
+        }
+    }
+    for (auto&& i : list_list)
+    {
+        auto previous_it = previous.list_list.find(i.first);
+        if (previous_it != previous.list_list.end() &&
+            is_unchanged("lists", i.first))
+        {
+            i.second.second = previous_it->second.second;
+        }
     }
 }
 auto stage::get_variable_list() -> decltype(variable_list)&
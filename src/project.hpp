@@ -22,6 +22,10 @@
 #include <SDL2/SDL_mixer.h>
 #include <boost/json.hpp>
 #include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stop_token>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -30,6 +34,7 @@
 #include <zip.h>
 namespace libsc3
 {
+    class asset_pool;
     class stage;
     class target
     {
@@ -39,27 +44,33 @@ namespace libsc3
         // a container to express scratch *any* type variables
         typedef std::variant<std::string, std::int64_t, double>
                              variable_value_type;
-        typedef SDL_Surface* renderer_surface_type;
-        typedef Mix_Chunk*   mixer_sound_type;
-        typedef zip_file_t*  element_file_type;
+        // media may be shared by several targets and by revisions of a
+        // target across project::reload
+        typedef std::shared_ptr<SDL_Surface> renderer_surface_type;
+        typedef std::shared_ptr<Mix_Chunk>   mixer_sound_type;
+        typedef zip_file_t*                  element_file_type;
 
     private:
-        stage&           stage_reference;
-        std::string_view name;
+        stage&      stage_reference;
+        std::string name;
 
         // store all objects in "variables"
         std::unordered_map<
             std::string, std::pair<std::string, variable_value_type>>
                                                           variable_list;
-        // store all objects in "sounds"
-        std::unordered_map<std::string, mixer_sound_type> sound_list;
+        // store all objects in "sounds", name -> (md5ext, sound)
+        std::unordered_map<
+            std::string, std::pair<std::string, mixer_sound_type>>
+                                                          sound_list;
         // store all objects in "lists"
         std::unordered_map<
             std::string,
             std::pair<std::string, std::vector<variable_value_type>>>
                                                                list_list;
-        // store all objects in "costumes"
-        std::unordered_map<std::string, renderer_surface_type> costume_list;
+        // store all objects in "costumes", name -> (md5ext, surface)
+        std::unordered_map<
+            std::string, std::pair<std::string, renderer_surface_type>>
+                                                               costume_list;
 
     public:
         /**
@@ -68,15 +79,57 @@ namespace libsc3
          * @param stage stage reference providing visibility for name looking up
          * @param json_value an value presenting this target
          * @param elem_list compressed file list fpr media loading
+         * @param pool decoded media to share before reading elem_list, media
+         * decoded here is added to it
          */
         target(
             stage& stage, boost::json::value& json_value,
-            std::unordered_map<std::string, element_file_type>& elem_list);
+            std::unordered_map<std::string, element_file_type>& elem_list,
+            asset_pool*                                         pool = nullptr);
+
+        target(
+            boost::json::value&                                 json_value,
+            std::unordered_map<std::string, element_file_type>& elem_list,
+            asset_pool*                                         pool = nullptr);
+
+        auto get_name() const -> const std::string&;
+        auto get_costume_list() const -> const decltype(costume_list)&;
+        auto get_sound_list() const -> const decltype(sound_list)&;
+
+        /**
+         * @brief add all decoded media of this target to pool
+         *
+         * @param pool pool to receive the media
+         */
+        void share_assets(asset_pool& pool) const;
+
+        /**
+         * @brief carry runtime values of variables and lists over from a
+         * previous incarnation of this target
+         *
+         * a value is carried over only if the saved entry with the same id,
+         * both name and initial value, is identical in the previous and the
+         * current json. otherwise the value just read from json is kept.
+         *
+         * @param previous target to copy values from
+         * @param previous_json the value previous was constructed from
+         * @param json_value the value this target was constructed from
+         */
+        void inherit_variables(
+            const target& previous, const boost::json::value& previous_json,
+            const boost::json::value& json_value);
+    };
 
-            target(
-             boost::json::value& json_value,
-            std::unordered_map<std::string, element_file_type>& elem_list);
-        ~target();
+    /**
+     * @brief decoded media keyed by "md5ext", shared by all targets constructed
+     * in one load, and with the targets being replaced while reloading
+     */
+    class asset_pool
+    {
+    public:
+        std::unordered_map<std::string, target::renderer_surface_type>
+                                                                 costume_list;
+        std::unordered_map<std::string, target::mixer_sound_type> sound_list;
     };
 
     class stage : public target
@@ -100,6 +153,10 @@ namespace libsc3
     public:
         typedef zip_t*      project_bundle_type;
         typedef zip_file_t* element_file_type;
+        // called once a target is ready, with the count of ready targets and
+        // the count of all targets, see project::project for the rules
+        typedef std::function<void(target&, std::size_t, std::size_t)>
+            progress_callback_type;
 
     private:
         boost::json::object                                project_source;
@@ -108,6 +165,24 @@ namespace libsc3
         std::unordered_map<std::string, target>            target_list;
         decltype(target_list)::iterator                    stage_target;
 
+        /**
+         * @brief insert a target into a target list, checking stage ordering
+         *
+         * @param list the list to insert into
+         * @param list_stage the stage of list, updated once a stage is inserted
+         * @param elem_list compressed file list fpr media loading
+         * @param json_value an value presenting this target
+         * @param previous an unchanged target to reuse, moved from only once
+         * inserted, constructed if null
+         * @param pool decoded media to share when constructing
+         * @return the inserted target
+         */
+        static target& emplace_target(
+            decltype(target_list)& list, decltype(stage_target)& list_stage,
+            std::unordered_map<std::string, element_file_type>& elem_list,
+            boost::json::value&                                 json_value,
+            decltype(target_list)::node_type* previous, asset_pool* pool);
+
     public:
         /**
          * @brief constructor
@@ -115,7 +190,80 @@ namespace libsc3
          * @param path an value presenting the .sb3 file
          */
         project(const std::filesystem::path& path);
+
+        /**
+         * @brief constructor reporting progress
+         *
+         * the first target listed, which must be the stage, is constructed
+         * first. the remaining ones are reordered so that visible sprites come
+         * before hidden ones, a stage listed anywhere but first still throws
+         * file_format_error.
+         *
+         * a target passed to callback is complete and never touched by the
+         * constructor again, it may be read from whichever thread callback
+         * hands it to until the project is destroyed. the project itself must
+         * not be accessed before it is constructed. if construction throws,
+         * targets already passed to callback are destroyed with it.
+         *
+         * @param path an value presenting the .sb3 file
+         * @param callback called after each target is constructed
+         * @param stop_token checked before each target, throws
+         * load_cancelled_error once stop is requested
+         */
+        project(
+            const std::filesystem::path& path, progress_callback_type callback,
+            std::stop_token stop_token = {});
         ~project();
+
+        /**
+         * @brief construct a project on a detached thread
+         *
+         * unlike one from std::async, destroying the returned future never
+         * blocks, an abandoned load runs to its end or to its cancellation
+         * in background.
+         *
+         * @param path an value presenting the .sb3 file
+         * @param callback called on the loading thread after each target is
+         * constructed
+         * @param stop_token request stop to cancel loading between targets
+         * @return a future holding the project, or the exception thrown while
+         * constructing it
+         *
+         * @note callback and everything it refers to must stay alive until the
+         * future is ready.
+         * @note SDL must stay initialised until the loading thread ends, not
+         * only until the future is ready: if the future is dropped, the
+         * project is destroyed on that thread after it signalled.
+         */
+        static auto load_async(
+            const std::filesystem::path& path,
+            progress_callback_type       callback   = nullptr,
+            std::stop_token              stop_token = {})
+            -> std::future<std::unique_ptr<project>>;
+
+        /**
+         * @brief get the stage of this project
+         *
+         * @exception std::out_of_range the project has no stage
+         */
+        auto get_stage() -> stage&;
+
+        /**
+         * @brief replace this project with another revision of it
+         *
+         * targets whose json is unchanged are kept as they are, others are
+         * reconstructed sharing media with the same md5ext and taking runtime
+         * values of variables and lists over from the previous ones, see
+         * target::inherit_variables.
+         *
+         * @param path an value presenting the .sb3 file
+         *
+         * @note sprites refer to the stage, so all of them are reconstructed
+         * once the stage changed.
+         * @note the new revision is built aside and swapped in only on
+         * success, if anything throws the project is left untouched.
+         */
+        void reload(const std::filesystem::path& path);
     };
 
 } // namespace libsc3
@@ -0,0 +1,73 @@
+#include <exception.hpp>
+#include <project.hpp>
+#include <player.hpp>
+#include <string>
+#include <vector>
+int main()
+{
+    [[maybe_unused]] auto a = libsc3::player();
+
+    // the stage comes first and counts go up one by one.
+    std::vector<std::string> loaded_names;
+    std::size_t              last_loaded = 0;
+    std::size_t              last_total  = 0;
+    bool                     in_order    = true;
+    auto                     f           = libsc3::project::load_async(
+        "./basic_sb3.sb3",
+        [&](libsc3::target& t, std::size_t loaded, std::size_t total) {
+            in_order = in_order && loaded == last_loaded + 1 && loaded <= total;
+            last_loaded = loaded;
+            last_total  = total;
+            loaded_names.push_back(t.get_name());
+            if (t.get_costume_list().empty())
+            {
+                in_order = false;
+            }
+        });
+    [[maybe_unused]] auto p = f.get();
+    if (!in_order || loaded_names.empty() || loaded_names.front() != "Stage" ||
+        last_loaded != loaded_names.size() || last_loaded != last_total)
+    {
+        return 1;
+    }
+
+    // errors are rethrown from the future.
+    try
+    {
+        libsc3::project::load_async("./not_existing.sb3").get();
+        return 2;
+    }
+    catch (const libsc3::libzip_runtime_error&)
+    {
+    }
+
+    // a requested stop cancels loading before the first target.
+    std::stop_source stop;
+    stop.request_stop();
+    try
+    {
+        libsc3::project::load_async(
+            "./basic_sb3.sb3", nullptr, stop.get_token())
+            .get();
+        return 3;
+    }
+    catch (const libsc3::load_cancelled_error&)
+    {
+    }
+
+    // an SDL error raised on the loading thread keeps its message.
+    SDL_ClearError();
+    try
+    {
+        libsc3::project::load_async("./async_sb3_broken_costume.sb3").get();
+        return 4;
+    }
+    catch (const libsc3::libsdl_runtime_error& e)
+    {
+        if (std::string(e.what()) == "libsdl_error: ")
+        {
+            return 5;
+        }
+    }
+    return 0;
+}
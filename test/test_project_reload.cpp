@@ -0,0 +1,103 @@
+#include <project.hpp>
+#include <player.hpp>
+#include <exception>
+int main()
+{
+    [[maybe_unused]] auto a = libsc3::player();
+    auto                  p = libsc3::project("./basic_sb3.sb3");
+
+    static const std::string my_variable_id =
+        "`jEk@4|i[#Fk?(8x)AV.-my variable";
+    static const std::string second_variable_id = "reload-second-variable";
+
+    auto set_variable = [&](const std::string& id, std::int64_t value) {
+        p.get_stage().get_variable_list().at(id).second = value;
+    };
+    auto variable_is = [&](const std::string& id, std::int64_t value) {
+        auto&& variable = p.get_stage().get_variable_list().at(id).second;
+        auto   number   = std::get_if<std::int64_t>(&variable);
+        return number != nullptr && *number == value;
+    };
+    auto stage_costume = [&](const std::string& name) {
+        return p.get_stage().get_costume_list().at(name).second.get();
+    };
+    auto stage_sound = [&](const std::string& name) {
+        return p.get_stage().get_sound_list().at(name).second.get();
+    };
+
+    // unchanged revision, every target is kept as it is.
+    set_variable(my_variable_id, 42);
+    auto&& stage_before = p.get_stage();
+    p.reload("./basic_sb3.sb3");
+    if (&p.get_stage() != &stage_before || !variable_is(my_variable_id, 42))
+    {
+        return 1;
+    }
+
+    // stage and sprite changed, sprite added: the runtime value of an
+    // unchanged variable carries over, a new variable takes its saved value.
+    // the reconstructed stage shares media with unchanged md5ext.
+    auto backdrop = stage_costume("backdrop1");
+    auto pop      = stage_sound("pop");
+    p.reload("./reload_sb3_rev2.sb3");
+    if (!variable_is(my_variable_id, 42) ||
+        !variable_is(second_variable_id, 7) ||
+        stage_costume("backdrop1") != backdrop || stage_sound("pop") != pop)
+    {
+        return 2;
+    }
+
+    // an initial value edited in the editor wins over the runtime value.
+    set_variable(second_variable_id, 8);
+    p.reload("./reload_sb3_rev3.sb3");
+    if (!variable_is(my_variable_id, 3) ||
+        !variable_is(second_variable_id, 8) ||
+        stage_costume("backdrop1") != backdrop || stage_sound("pop") != pop)
+    {
+        return 3;
+    }
+
+    // broken revisions must leave the project untouched.
+    for (auto&& i :
+         { "./reload_sb3_broken.sb3", "./reload_sb3_misordered.sb3",
+           "./reload_sb3_malformed.sb3", "./reload_sb3_missing.sb3" })
+    {
+        auto&& stage_kept = p.get_stage();
+        try
+        {
+            p.reload(i);
+            return 4;
+        }
+        catch (const std::exception&)
+        {
+        }
+        if (&p.get_stage() != &stage_kept || !variable_is(my_variable_id, 3) ||
+            !variable_is(second_variable_id, 8))
+        {
+            return 5;
+        }
+    }
+
+    // and can still be reloaded afterwards.
+    p.reload("./reload_sb3_rev3.sb3");
+    if (!variable_is(second_variable_id, 8))
+    {
+        return 6;
+    }
+
+    // a new md5ext used by the stage and several times by sprites is decoded
+    // once and shared.
+    p.reload("./reload_sb3_new_asset.sb3");
+    if (stage_costume("backdrop1") != backdrop ||
+        stage_costume("backdrop2") == nullptr)
+    {
+        return 7;
+    }
+
+    // revisions with a md5ext used more than once load on their own as well.
+    for (auto&& i : { "./reload_sb3_rev2.sb3", "./reload_sb3_new_asset.sb3" })
+    {
+        [[maybe_unused]] auto q = libsc3::project(i);
+    }
+    return 0;
+}